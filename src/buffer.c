@@ -0,0 +1,156 @@
+/* 
+ * This file is part of mq.
+ * mq - src/buffer.c
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "utils.h"
+
+/* 
+ * Create and initialise a Buffer
+ * args:   void
+ * return: Buffer or NULL on error
+ */
+Buffer * buffer_new (void)
+{
+	Buffer * buffer = malloc0 (sizeof (Buffer));
+	if (buffer == NULL)
+		return NULL;
+
+	/* The memory is only allocated once something is written */
+	buffer->_data = NULL;
+	buffer->_start = 0;
+	buffer->_end = 0;
+	buffer->_size = 0;
+
+	return buffer;
+}
+
+/*
+ * Delete and free a Buffer
+ * args:   Buffer
+ * return: void
+ */
+void buffer_del (Buffer * self)
+{
+	free (self->_data);
+	free (self);
+}
+
+/*
+ * Return a pointer to the first byte not consumed
+ * args:   Buffer
+ * return: pointer to the data
+ */
+char * buffer_data (Buffer * self)
+{
+	return self->_data + self->_start;
+}
+
+/*
+ * Return the number of bytes not consumed
+ * args:   Buffer
+ * return: number of bytes
+ */
+size_t buffer_len (Buffer * self)
+{
+	return self->_end - self->_start;
+}
+
+/*
+ * Make room for len more bytes at the end of the Buffer, these can then
+ * be written directly (eg: by recv ()) before calling buffer_commit ()
+ * args:   Buffer, number of bytes
+ * return: pointer to the free space or NULL on error
+ */
+char * buffer_reserve (Buffer * self, size_t len)
+{
+	size_t size;
+	char * tmp;
+
+	if (self->_size - self->_end >= len)
+		return self->_data + self->_end;
+
+	/* Move the data back to the start of the Buffer if that's enough */
+	if (self->_start > 0 && self->_size - buffer_len (self) >= len) {
+		memmove (self->_data, buffer_data (self), buffer_len (self));
+		self->_end -= self->_start;
+		self->_start = 0;
+		return self->_data + self->_end;
+	}
+
+	/* Otherwise grow the Buffer geometrically */
+	size = (self->_size > 0) ? self->_size : BUFFER_MIN_SIZE;
+	while (size - buffer_len (self) < len)
+		size *= 2;
+
+	tmp = realloc (self->_data, size);
+	if (tmp == NULL)
+		return NULL;
+	self->_data = tmp;
+	self->_size = size;
+
+	return buffer_reserve (self, len);
+}
+
+/*
+ * Add len bytes written in the space returned by buffer_reserve ()
+ * args:   Buffer, number of bytes
+ * return: void
+ */
+void buffer_commit (Buffer * self, size_t len)
+{
+	self->_end += len;
+}
+
+/*
+ * Copy data at the end of the Buffer
+ * args:   Buffer, data, number of bytes
+ * return: 0 on success, 1 on error
+ */
+int buffer_append (Buffer * self, const void * data, size_t len)
+{
+	char * p = buffer_reserve (self, len);
+
+	if (p == NULL)
+		return 1;
+
+	memcpy (p, data, len);
+	buffer_commit (self, len);
+
+	return 0;
+}
+
+/*
+ * Drop len bytes from the start of the Buffer
+ * args:   Buffer, number of bytes
+ * return: void
+ */
+void buffer_consume (Buffer * self, size_t len)
+{
+	if (len >= buffer_len (self)) {
+		/* Empty, start again from the beginning */
+		self->_start = 0;
+		self->_end = 0;
+		return;
+	}
+
+	self->_start += len;
+}
@@ -0,0 +1,48 @@
+/* 
+ * This file is part of mq.
+ * mq - src/buffer.h
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUFFER_H
+#define BUFFER_H
+
+#include <stddef.h>
+
+#define BUFFER_MIN_SIZE	4096	/* initial size of the buffer */
+
+typedef struct _Buffer Buffer;
+
+/* Growable FIFO of bytes: data is appended at the end and consumed from
+ * the start */
+struct _Buffer 
+{
+	char * _data;
+	size_t _start;		/* offset of the first byte not consumed */
+	size_t _end;		/* offset after the last byte */
+	size_t _size;		/* allocated size */
+};
+
+Buffer * buffer_new (void);
+void buffer_del (Buffer * self);
+char * buffer_data (Buffer * self);
+size_t buffer_len (Buffer * self);
+char * buffer_reserve (Buffer * self, size_t len);
+void buffer_commit (Buffer * self, size_t len);
+int buffer_append (Buffer * self, const void * data, size_t len);
+void buffer_consume (Buffer * self, size_t len);
+
+#endif /* BUFFER_H */
@@ -0,0 +1,270 @@
+/* 
+ * This file is part of mq.
+ * mq - src/connection.c
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "connection.h"
+#include "utils.h"
+
+/* 
+ * Create a Connection for an accepted socket
+ * args:   socket
+ * return: Connection or NULL on error
+ */
+Connection * connection_new (int sock)
+{
+	Connection * connection = malloc0 (sizeof (Connection));
+	if (connection == NULL)
+		return NULL;
+
+	connection->sock = sock;
+	connection->state = READING;
+	connection->eof = 0;
+	connection->_scanned = 0;
+	connection->_out_len = 0;
+	connection->events = 0;
+
+	connection->_in = buffer_new ();
+	if (connection->_in == NULL) {
+		free (connection);
+		return NULL;
+	}
+
+	connection->_out = list_new ();
+	if (connection->_out == NULL) {
+		buffer_del (connection->_in);
+		free (connection);
+		return NULL;
+	}
+
+	return connection;
+}
+
+/*
+ * Close the socket, delete and free a Connection
+ * args:   Connection
+ * return: void
+ */
+void connection_del (Connection * self)
+{
+	int i;
+
+	/* Free the Messages which couldn't be sent */
+	for (i = 0; i < list_len (self->_out); i++)
+		message_del (list_get_item (self->_out, i));
+	list_delete (self->_out);
+
+	buffer_del (self->_in);
+	close (self->sock);
+	free (self);
+}
+
+/*
+ * Queue a Message to be sent on the Connection by connection_flush ()
+ * args:   Connection, Message
+ * return: 0 on success, 1 on error
+ */
+int connection_queue_message (Connection * self, Message * message)
+{
+	size_t len;
+
+	if (list_append (self->_out, message))
+		return 1;
+
+	message_get_data (message, &len);
+	self->_out_len += len;
+
+	return 0;
+}
+
+/*
+ * Send as much of the queued Messages as the (non blocking) socket
+ * accepts, several Messages are gathered in each sendmsg () call
+ * args:   Connection
+ * return: 0 on success (there may be data left to send), 1 on error
+ */
+int connection_flush (Connection * self)
+{
+	struct iovec iov[SEND_IOV];
+	struct msghdr msg;
+	Message * message;
+	size_t len, total, left;
+	ssize_t sent;
+	int i, n_iov, n_sent;
+
+	while (list_len (self->_out) > 0)
+	{
+		/* Gather the first Messages */
+		total = 0;
+		n_iov = list_len (self->_out);
+		if (n_iov > SEND_IOV)
+			n_iov = SEND_IOV;
+		for (i = 0; i < n_iov; i++) {
+			message = list_get_item (self->_out, i);
+			iov[i].iov_base = message_get_data (message, &len);
+			iov[i].iov_len = len;
+			total += len;
+		}
+
+		bzero (&msg, sizeof (struct msghdr));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = n_iov;
+
+		/* MSG_NOSIGNAL: a Client going away mustn't raise SIGPIPE */
+		sent = sendmsg (self->sock, &msg, MSG_NOSIGNAL);
+		if (sent == -1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return 0;
+			if (errno == EINTR)
+				continue;
+			return 1;
+		}
+		self->_out_len -= sent;
+
+		/* Drop the Messages which have been completely sent */
+		left = sent;
+		for (n_sent = 0; n_sent < n_iov; n_sent++)
+		{
+			message = list_get_item (self->_out, n_sent);
+			if (left < iov[n_sent].iov_len) {
+				message_sent (message, left);
+				break;
+			}
+			message_sent (message, iov[n_sent].iov_len);
+			left -= iov[n_sent].iov_len;
+			message_del (message);
+		}
+		if (n_sent > 0)
+			list_remove_items (self->_out, 0, n_sent);
+
+		/* The socket's buffer is full, wait for EPOLLOUT */
+		if ((size_t) sent < total)
+			return 0;
+	}
+
+	return 0;
+}
+
+/*
+ * Return the number of bytes waiting to be sent
+ * args:   Connection
+ * return: number of bytes
+ */
+size_t connection_get_backlog (Connection * self)
+{
+	return self->_out_len;
+}
+
+/*
+ * Read what's available on the (non blocking) socket, up to RECV_SIZE
+ * bytes so that a single Client can't hold the Daemon
+ * args:   Connection
+ * return: 0 on success (eof is set if the Client shut its side down),
+ *		   1 on error
+ */
+int connection_recv (Connection * self)
+{
+	size_t total = 0;
+	ssize_t len;
+	char * p;
+
+	while (total < RECV_SIZE && !self->eof)
+	{
+		p = buffer_reserve (self->_in, BUFFER_MIN_SIZE);
+		if (p == NULL)
+			return 1;
+
+		len = recv (self->sock, p, BUFFER_MIN_SIZE, 0);
+		if (len == -1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if (errno == EINTR)
+				continue;
+			return 1;
+		}
+
+		if (len == 0)
+			self->eof = 1;
+
+		buffer_commit (self->_in, len);
+		total += len;
+	}
+
+	return 0;
+}
+
+/*
+ * Look for a complete command in the received bytes, a command is of
+ * the form "arg1\0arg2\0arg3\0\n"
+ * args:   Connection, pointer to store the length of the command
+ * return: pointer to the command (valid until connection_consume ()),
+ *		   or NULL if no command has been completely received
+ */
+char * connection_get_command (Connection * self, size_t * len)
+{
+	char * data = buffer_data (self->_in);
+	char * p;
+
+	/* Only search the bytes received since the last call */
+	while (self->_scanned < buffer_len (self->_in))
+	{
+		p = memchr (data + self->_scanned, '\n',
+					buffer_len (self->_in) - self->_scanned);
+		if (p == NULL) {
+			self->_scanned = buffer_len (self->_in);
+			break;
+		}
+
+		self->_scanned = p - data + 1;
+
+		/* A '\n' inside an argument isn't the end of the command */
+		if (p > data && *(p - 1) == '\0') {
+			*len = self->_scanned;
+			return data;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Drop a command returned by connection_get_command ()
+ * args:   Connection, length of the command
+ * return: void
+ */
+void connection_consume (Connection * self, size_t len)
+{
+	buffer_consume (self->_in, len);
+	self->_scanned = 0;
+}
+
+/*
+ * Return the number of received bytes not consumed yet
+ * args:   Connection
+ * return: number of bytes
+ */
+size_t connection_pending (Connection * self)
+{
+	return buffer_len (self->_in);
+}
@@ -0,0 +1,63 @@
+/* 
+ * This file is part of mq.
+ * mq - src/connection.h
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include <stddef.h>
+
+#include "buffer.h"
+#include "list.h"
+#include "message.h"
+
+#define RECV_SIZE	65536	/* max bytes read from a Connection per event */
+#define SEND_IOV	64		/* max Messages sent by a single sendmsg () */
+
+/* State of a Client's connection */
+typedef enum {
+	READING,	/* Waiting for a command */
+	WRITING		/* Sending the reply to the command */
+} ConnState;
+
+typedef struct _Connection Connection;
+
+/* A Client connected to the Daemon, used as epoll's data.ptr */
+struct _Connection 
+{
+	int sock;
+	ConnState state;
+	short int eof;			/* the Client has shut its side down */
+	unsigned int events;	/* epoll events currently watched */
+	Buffer * _in;			/* received bytes not parsed yet */
+	size_t _scanned;		/* bytes of _in searched for the end of a command */
+	List * _out;			/* Messages waiting to be sent, in order */
+	size_t _out_len;		/* number of bytes waiting to be sent */
+};
+
+Connection * connection_new (int sock);
+void connection_del (Connection * self);
+int connection_queue_message (Connection * self, Message * message);
+int connection_flush (Connection * self);
+size_t connection_get_backlog (Connection * self);
+int connection_recv (Connection * self);
+char * connection_get_command (Connection * self, size_t * len);
+void connection_consume (Connection * self, size_t len);
+size_t connection_pending (Connection * self);
+
+#endif /* CONNECTION_H */
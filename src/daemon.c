@@ -17,6 +17,8 @@
  * along with mq.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#define _GNU_SOURCE		/* accept4 () */
+
 #include <stdlib.h>
 #include <fcntl.h>
 #include <sys/epoll.h>
@@ -28,6 +30,7 @@
 #include <sys/socket.h>
 #include <stdio.h>
 #include <sys/wait.h>
+#include <sys/signalfd.h>
 
 #include "daemon.h"
 #include "logger.h"
@@ -35,7 +38,8 @@
 #include "utils.h"
 
 #define MAX_EVENTS	64
-#define TIMEOUT		1000
+#define MAX_OUTPUT	(1024 * 1024)	/* stop reading above this much pending output */
+#define MAX_COMMAND_LEN	(16 * 1024 * 1024)	/* max size of a command */
 #define BACKLOG		5		/* backlog for listen () */
 #define FORK		1
 
@@ -47,10 +51,16 @@ static MessageType _daemon_parse_line (Daemon * self, char * line,
 									   int len, char ** message);
 static void _daemon_block_signals (Daemon * self);
 static void _daemon_unblock_signals (Daemon * self);
-static int _daemon_read_socket (Daemon * self, int sock);
+static void _daemon_read_sigfd (Daemon * self);
+static int _daemon_read_socket (Daemon * self, Connection * connection);
+static void _daemon_close_connection (Daemon * self, Connection * connection);
+static int _daemon_update_connection (Daemon * self, Connection * connection);
 static MessageType _daemon_action_add (Daemon * self, char ** argv, char ** message);
 static MessageType _daemon_action_list (Daemon * self, char ** message);
 static MessageType _daemon_action_move (Daemon * self, char ** argv, char ** message);
+static int _daemon_get_uids (Daemon * self, char * uids, Process *** ps,
+							 char ** message);
+static int _daemon_uid_cmp (const void * a, const void * b);
 static MessageType _daemon_action_pause (Daemon * self, char ** argv, char ** message);
 static MessageType _daemon_action_remove (Daemon * self, char ** argv, char ** message);
 static MessageType _daemon_action_resume (Daemon * self, char ** argv, char ** message);
@@ -129,10 +139,11 @@ Daemon * daemon_new (char * sock_path, char * pid_path, char * log_path)
 		logger_log (daemon->_log, CRITICAL, "daemon_new:epoll_create");
 
 	daemon->_running = 0;
+	daemon->_sigfd = -1;
 
 	/* We want to be notified when there is data to read */
 	bzero (&event, sizeof(struct epoll_event));
-	event.data.fd = daemon->_sock;
+	event.data.ptr = &daemon->_sock;
 	event.events = EPOLLIN;
 	if (epoll_ctl (daemon->_epfd, EPOLL_CTL_ADD, daemon->_sock, &event) == -1)
 		logger_log (daemon->_log, CRITICAL, "daemon_new:epoll_ctl");
@@ -144,13 +155,6 @@ Daemon * daemon_new (char * sock_path, char * pid_path, char * log_path)
 		exit (EXIT_FAILURE);
 	}
 
-	/* Initialise list of Messages */
-	daemon->_mlist = messagelist_new ();
-	if (daemon->_mlist == NULL) {
-		perror ("daemon_new:list_new");
-		exit (EXIT_FAILURE);
-	}
-
 	return daemon;
 }
 
@@ -164,7 +168,7 @@ void daemon_run (Daemon * self)
 	struct epoll_event * events;
 	int i, n_events, sock;
 	struct epoll_event event;
-	Message * message;
+	Connection * connection;
 
 	/* Daemonize */
 	if (_daemon_daemonize (self))
@@ -177,9 +181,10 @@ void daemon_run (Daemon * self)
 	if (events == NULL)
 		logger_log (self->_log, CRITICAL, "daemon_run:malloc0");
 
-	/* Main loop */
+	/* Main loop, there is no timeout: children exiting wake us up
+	 * through _sigfd */
 	for (;;) {
-		n_events = epoll_wait (self->_epfd, events, MAX_EVENTS, TIMEOUT);
+		n_events = epoll_wait (self->_epfd, events, MAX_EVENTS, -1);
 
 		if (n_events < 0) {
 			if (errno == EINTR) /* call was interrupted by a signal handler */
@@ -187,19 +192,15 @@ void daemon_run (Daemon * self)
 			logger_log (self->_log, CRITICAL, "daemon_run:epoll_wait");
 		}
 
-		/* Wait for any processes */
-		_daemon_wait_processes (self);
-
-		/* Run processes if any slots available */
-		_daemon_run_processes (self);
-
-		if (n_events == 0) {
-			/* Waited for TIMEOUT ms */
-		}
-
 		/* Loop on all events */
 		for (i = 0; i < n_events; i++) {
-			if (events[i].data.fd == self->_sock) 
+			if (events[i].data.ptr == &self->_sigfd)
+			{
+				/* One or more children changed state, the actual
+				 * waiting is done below once all events are handled */
+				_daemon_read_sigfd (self);
+			}
+			else if (events[i].data.ptr == &self->_sock) 
 			{
 				/* Check that the socket is ready */
 				if (!(events[i].events & EPOLLIN))
@@ -208,86 +209,68 @@ void daemon_run (Daemon * self)
 
 				/* Main socket is ready */
 				/* Accept the new connection */
-				sock = accept (self->_sock, NULL, NULL);
+				sock = accept4 (self->_sock, NULL, NULL, SOCK_NONBLOCK);
 				if (sock == -1)
 					logger_log (self->_log, CRITICAL, "daemon_run:accept");
 
+				connection = connection_new (sock);
+				if (connection == NULL)
+					logger_log (self->_log, CRITICAL, "daemon_run:connection_new");
+
 				/* Add the new socket to our epoll_event */
 				bzero(&event, sizeof (struct epoll_event));
 				event.events = EPOLLIN;
-				event.data.fd = sock;
+				event.data.ptr = connection;
+				connection->events = event.events;
 				if (epoll_ctl (self->_epfd, EPOLL_CTL_ADD, sock, &event) == -1)
 					logger_log (self->_log, CRITICAL, "daemon_run:epoll_ctl");
 			} 
 			else 
 			{
-				/* Handle the existing socket */
+				/* Handle the existing connection */
+				connection = events[i].data.ptr;
 
 				/* Close socket if Client closed it */
 				if (events[i].events & EPOLLHUP || events[i].events & EPOLLERR)
 				{
-					/* This should not be necessary according to epoll(7)
-					 * but removing it causes "Bad file descriptor" errors */
-					if (epoll_ctl (self->_epfd, EPOLL_CTL_DEL, 
-						events[i].data.fd, NULL) == -1)
-						logger_log (self->_log, CRITICAL, "daemon_run:epoll_ctl (3)");
-
 					logger_log (self->_log, DEBUG,
-							"Client closed socket (%d)", events[i].data.fd);
-					if (close (events[i].data.fd) == -1)
-						logger_log (self->_log, CRITICAL, "daemon_run:close");
+							"Client closed socket (%d)", connection->sock);
+					_daemon_close_connection (self, connection);
 					continue;
 				}
 
 				/* Write to socket if it's ready */
 				if (events[i].events & EPOLLOUT) 
 				{
-					/* Look for any Message for the current socket */
-					message = messagelist_get_message_by_sock (self->_mlist,
-															   events[i].data.fd);
-					if (message == NULL)
-					{
-						sleep (3600);
-						logger_log (self->_log, CRITICAL,
-									"Can't find message for socket %d, this shouln't happen",
-									events[i].data.fd);
+					/* Send what's left of the replies */
+					if (connection_flush (connection)) {
+						logger_log (self->_log, WARNING, "Can't write to socket (%d)",
+									connection->sock);
+						_daemon_close_connection (self, connection);
+						continue;
 					}
-
-					/* Send the message */
-					logger_log (self->_log, DEBUG, "Send message to socket (%s)", message->_content);
-					if (message_send (message))
-						logger_log (self->_log, CRITICAL, "daemon_run:message_send");
 					logger_log (self->_log, DEBUG, "Sent message to socket (%d)",
-								events[i].data.fd);
-
-					/* Remove message from the MessageList */
-					if (messagelist_remove (self->_mlist, message))
-						logger_log (self->_log, CRITICAL,
-									"daemon_run:_messagelist_remove");
-
-					message_del (message);
-
-					/* We can now close the socket */
-					/* This should not be necessary according to epoll(7)
-					 * but removing it causes "Bad file descriptor" errors */
-					if (epoll_ctl (self->_epfd, EPOLL_CTL_DEL, 
-						events[i].data.fd, NULL) == -1)
-						logger_log (self->_log, CRITICAL, "daemon_run:epoll_ctl (2)");
+								connection->sock);
 
-					if (close (events[i].data.fd) == -1)
-						logger_log (self->_log, CRITICAL, "daemon_run:close");
+					if (_daemon_update_connection (self, connection))
+						continue;
 				}
 
 				/* Read from socket if it's ready */
 				if (events[i].events & EPOLLIN) 
 				{
-					logger_log (self->_log, DEBUG, "daemon_run:epoll_ctl (3)");
-					if (_daemon_read_socket(self, events[i].data.fd))
+					if (_daemon_read_socket(self, connection))
 						logger_log (self->_log, CRITICAL,
 									"daemon_run:_daemon_read_socket");
 				}
 			}
 		}
+
+		/* Wait for any processes */
+		_daemon_wait_processes (self);
+
+		/* Run processes if any slots available */
+		_daemon_run_processes (self);
 	}
 }
 
@@ -313,6 +296,10 @@ void daemon_delete (Daemon * self)
 		if (close (self->_sock) == -1)
 			logger_log (self->_log, CRITICAL, "daemon_delete:close");
 
+		/* Close the signalfd */
+		if (close (self->_sigfd) == -1)
+			logger_log (self->_log, CRITICAL, "daemon_delete:close");
+
 		/* Unlink the socket's path */
 		if (unlink (self->_sock_path) == -1)
 			logger_log (self->_log, CRITICAL, "daemon_delete:unlink '%s'", self->_sock_path);
@@ -327,7 +314,6 @@ void daemon_delete (Daemon * self)
 
 	/* Free up memory */
 	pslist_delete (self->_pslist);
-	messagelist_delete (self->_mlist);
 
 	if (self->_running)
 		exit (EXIT_SUCCESS);
@@ -343,6 +329,8 @@ void daemon_delete (Daemon * self)
 static int _daemon_daemonize (Daemon * self)
 {
 	struct sigaction sigterm_action;
+	struct epoll_event event;
+	sigset_t chld_mask;
 	FILE * pid_file;
 	pid_t pid;
 
@@ -383,6 +371,26 @@ static int _daemon_daemonize (Daemon * self)
 	if (sigaction (SIGTERM, &sigterm_action, NULL) == -1)
 		logger_log (self->_log, CRITICAL, "_daemon_daemonize:sigaction");
 
+	/* SIGCHLD is permanently blocked and delivered through a signalfd
+	 * watched by epoll, so that a child exiting wakes up the main loop
+	 * (the mask is reset in the children by process_run) */
+	if (sigemptyset (&chld_mask) == -1)
+		logger_log (self->_log, CRITICAL, "_daemon_daemonize:sigemptyset");
+	if (sigaddset (&chld_mask, SIGCHLD) == -1)
+		logger_log (self->_log, CRITICAL, "_daemon_daemonize:sigaddset");
+	if (sigprocmask (SIG_BLOCK, &chld_mask, NULL) == -1)
+		logger_log (self->_log, CRITICAL, "_daemon_daemonize:sigprocmask");
+
+	self->_sigfd = signalfd (-1, &chld_mask, SFD_NONBLOCK);
+	if (self->_sigfd == -1)
+		logger_log (self->_log, CRITICAL, "_daemon_daemonize:signalfd");
+
+	bzero (&event, sizeof(struct epoll_event));
+	event.data.ptr = &self->_sigfd;
+	event.events = EPOLLIN;
+	if (epoll_ctl (self->_epfd, EPOLL_CTL_ADD, self->_sigfd, &event) == -1)
+		logger_log (self->_log, CRITICAL, "_daemon_daemonize:epoll_ctl");
+
 	/* Close stdin, stdout, stderr */
 	close (0);
 	close (1);
@@ -408,74 +416,31 @@ static int _daemon_daemonize (Daemon * self)
  */
 static void _daemon_run_processes (Daemon * self)
 {
-	int n_running = 0;		/* number of Processes currently running */
-	int n_waiting = 0;		/* number of Processes waiting */
-	int * l_waiting = NULL;	/* array of Processes waiting */
 	Process * p = NULL;
 	char * s;
-	int i;
 
 	/* Block signals */
 	_daemon_block_signals (self);
 
-	/* Check if the number of running processes is less than 
-	 * the number of CPUs available */
-	n_running = pslist_get_nps (self->_pslist, RUNNING, NULL);
-	if (n_running >= self->_ncpus) {
-		/* Unblock signals */
-		_daemon_unblock_signals (self);
-		return ;
-	}
-
-	/* Get the number of processes waiting */
-	n_waiting = pslist_get_nps (self->_pslist, WAITING, NULL);
-
-	/* We only check this as the following malloc(0) would
-	 * fail when running with -lefence, FIXME: this is not the case with
-	 * malloc0 */
-	if (n_waiting == 0)
+	/* Start the first ready Processes as long as the number of running
+	 * processes is less than the number of CPUs available, paused
+	 * Processes are never in the ready queue */
+	while (pslist_count (self->_pslist, RUNNING) < self->_ncpus &&
+		   (p = pslist_get_first (self->_pslist, WAITING)) != NULL)
 	{
-		/* No processes are currently waiting */
-		/* Unblock signals */
-		_daemon_unblock_signals (self);
-		return ;
-	}
-
-	/* Get the list of processes waiting */
-	l_waiting  = malloc0 (n_waiting * sizeof (int));
-	if (l_waiting == NULL) {
-		logger_log (self->_log, WARNING, "_daemon_run_processes:malloc0");
-		/* Unblock signals */
-		_daemon_unblock_signals (self);
-		return ;
-	}
-
-	pslist_get_nps (self->_pslist, WAITING, l_waiting);
-
-	/* Start as many Processes as we have free CPUs */
-	for (i = 0; (i < n_waiting) && (n_running < self->_ncpus); i++)
-	{
-		p = pslist_get_ps (self->_pslist, l_waiting[i]);
-
-		/* Skip paused Processes */
-		if (p->is_paused)
-			continue;
-
-		if (process_run (p) == 0) {
+		if (pslist_run_ps (self->_pslist, p) == 0) {
 			s = process_str (p);
 			logger_log (self->_log, DEBUG, "Running Process (%d): '%s'", p->uid, s);
 			free (s);
-			n_running++;
 		} else {
 			s = process_str (p);
 			logger_log (self->_log, WARNING, "Failed to run Process: '%s'", s);
 			free (s);
+			/* Try again later */
+			break;
 		}
-
 	}
 
-	free (l_waiting);
-
 	/* Unblock signals */
 	_daemon_unblock_signals (self);
 }
@@ -518,8 +483,8 @@ static void _daemon_wait_processes (Daemon * self)
 						siginfo->si_pid);
 
 		/* "Wait" on the process */
-		if (process_wait (p, siginfo))
-			logger_log (self->_log, CRITICAL, "_daemon_wait_processes:process_wait", 
+		if (pslist_wait_ps (self->_pslist, p, siginfo))
+			logger_log (self->_log, CRITICAL, "_daemon_wait_processes:pslist_wait_ps", 
 						siginfo->si_pid);
 
 		logger_log (self->_log, DEBUG, "_daemon_wait_processes:waited on process (%d)",
@@ -571,11 +536,15 @@ static MessageType _daemon_parse_line (Daemon * self, char * line,
 		return KO;
 
 	/* Strip heading whitespaces */
-	while (*line == ' ')
+	while (len > 0 && *line == ' ') {
 		line++;
+		len--;
+	}
 
-	/* Count the number of arguments (ie: number of '\0') */
-	for (i = 0; line[i] != '\n'; i++)
+	/* Count the number of arguments (ie: number of '\0'), arguments
+	 * may contain '\n' so we rely on the length rather than looking
+	 * for the final '\n' */
+	for (i = 0; i < len - 1; i++)
 		if (line[i] == '\0')
 			argc++;
 
@@ -694,54 +663,154 @@ static void _daemon_unblock_signals (Daemon * self)
 		logger_log (self->_log, CRITICAL, "_daemon_unblock_signals:sigprocmask");
 }
 
+/*
+ * Drain the pending SIGCHLD notifications from the signalfd
+ * args:   Daemon
+ * return: void
+ */
+static void _daemon_read_sigfd (Daemon * self)
+{
+	struct signalfd_siginfo info;
+	ssize_t len;
+
+	/* Several SIGCHLD can be coalesced in a single notification, hence
+	 * the children are waited on with waitid () rather than based on
+	 * ssi_pid */
+	for (;;)
+	{
+		len = read (self->_sigfd, &info, sizeof (info));
+
+		if (len == -1) {
+			if (errno == EAGAIN)	/* signalfd is drained */
+				break;
+			if (errno == EINTR)
+				continue;
+			logger_log (self->_log, CRITICAL, "_daemon_read_sigfd:read");
+		}
+
+		if (len != sizeof (info))
+			logger_log (self->_log, CRITICAL,
+						"_daemon_read_sigfd: Unexpected read size: %d", (int) len);
+	}
+}
+
 /* 
- * Read from the given socket
- * args:   Daemon, socket
+ * Read a command from the given Connection
+ * args:   Daemon, Connection
  * return: 0 on success, 1 on error
  */
-static int _daemon_read_socket (Daemon * self, int sock)
+static int _daemon_read_socket (Daemon * self, Connection * connection)
 {
-	char buf[LINE_MAX];
 	MessageType type;
-	struct epoll_event event;
-	int len;
+	size_t len;
+	char * command;
 	char * message_content = NULL;
-	Message * message = NULL;;
-
-	len = recv (sock, buf, LINE_MAX, 0);
-
-	if (len < 0)
-		return 1;
+	Message * message = NULL;
+
+	/* Read what the Client sent so far */
+	if (connection_recv (connection)) {
+		logger_log (self->_log, WARNING, "Can't read from socket (%d)",
+					connection->sock);
+		_daemon_close_connection (self, connection);
+		return 0;
+	}
 
-	/* Other side has closed the socket */
-	if (len == 0) {
-		if (close(sock) == -1)
-			return 0;
+	/* Wait until a whole command is received */
+	command = connection_get_command (connection, &len);
+	if (command == NULL)
+	{
+		if (connection->eof) {
+			/* Other side has closed the socket */
+			_daemon_close_connection (self, connection);
+		} else if (connection_pending (connection) > MAX_COMMAND_LEN) {
+			logger_log (self->_log, WARNING, "Command too long on socket (%d)",
+						connection->sock);
+			_daemon_close_connection (self, connection);
+		}
+		return 0;
 	}
 
 	/* Parse the received line */
-	type = _daemon_parse_line (self, buf, len, &message_content);
+	type = _daemon_parse_line (self, command, len, &message_content);
+	connection_consume (connection, len);
 
 	/* Create new return message */
-	message = message_new (type, message_content, sock);
+	message = message_new (type, message_content);
 	if (message == NULL)
 		logger_log (self->_log, CRITICAL, "_daemon_read_socket:message_new");
 
-	/* Update the epoll event for _sock to be notified 
-	 * when it's ready to write */
+	/* Queue the reply and try to send it straight away, most of the
+	 * time the socket accepts it without waiting for EPOLLOUT */
+	if (connection_queue_message (connection, message))
+		logger_log (self->_log, CRITICAL, "_daemon_read_socket:connection_queue_message");
+	connection->state = WRITING;
+
+	if (connection_flush (connection)) {
+		logger_log (self->_log, WARNING, "Can't write to socket (%d)",
+					connection->sock);
+		_daemon_close_connection (self, connection);
+		return 0;
+	}
+
+	_daemon_update_connection (self, connection);
+
+	return 0;
+}
+
+/*
+ * Update the events watched on a Connection depending on its state:
+ * stop reading while too much output is waiting (the Client isn't
+ * reading its replies) and wait for EPOLLOUT only while there is some
+ * output left. The Connection is closed once its reply has been sent.
+ * args:   Daemon, Connection
+ * return: 1 if the Connection was closed, 0 otherwise
+ */
+static int _daemon_update_connection (Daemon * self, Connection * connection)
+{
+	struct epoll_event event;
+	size_t backlog;
+
+	backlog = connection_get_backlog (connection);
+
+	/* The reply has been sent, we're done with this Client */
+	if (connection->state == WRITING && backlog == 0) {
+		_daemon_close_connection (self, connection);
+		return 1;
+	}
+
 	bzero (&event, sizeof(struct epoll_event));
-	event.data.fd = sock;
-	event.events = EPOLLOUT;
-	if (epoll_ctl (self->_epfd, EPOLL_CTL_MOD, sock, &event) == -1)
-		logger_log (self->_log, CRITICAL, "_daemon_read_socket:epoll_ctl");
+	event.data.ptr = connection;
+	if (connection->state == READING && backlog < MAX_OUTPUT)
+		event.events |= EPOLLIN;
+	if (backlog > 0)
+		event.events |= EPOLLOUT;
 
-	/* Add message to message queue */
-	if (messagelist_append (self->_mlist, message))	
-		logger_log (self->_log, CRITICAL, "_daemon_read_socket:messagelist_append");
+	/* Avoid a syscall when nothing changed */
+	if (event.events == connection->events)
+		return 0;
+
+	if (epoll_ctl (self->_epfd, EPOLL_CTL_MOD, connection->sock, &event) == -1)
+		logger_log (self->_log, CRITICAL, "_daemon_update_connection:epoll_ctl");
+	connection->events = event.events;
 
 	return 0;
 }
 
+/* 
+ * Stop watching and close a Connection
+ * args:   Daemon, Connection
+ * return: void
+ */
+static void _daemon_close_connection (Daemon * self, Connection * connection)
+{
+	/* This should not be necessary according to epoll(7)
+	 * but removing it causes "Bad file descriptor" errors */
+	if (epoll_ctl (self->_epfd, EPOLL_CTL_DEL, connection->sock, NULL) == -1)
+		logger_log (self->_log, CRITICAL, "_daemon_close_connection:epoll_ctl");
+
+	connection_del (connection);
+}
+
 /*
  * Add a Process to the queue
  * args:   Daemon, additional arguments, pointer to return message string
@@ -751,6 +820,8 @@ static MessageType _daemon_action_add (Daemon * self, char ** argv, char ** mess
 {
 	Process * p;
 	char * s = NULL;
+	char ** ps_argv;
+	int argc, i;
 
 	/* Check for extra arguments */
 	if (*argv == NULL) {
@@ -761,8 +832,21 @@ static MessageType _daemon_action_add (Daemon * self, char ** argv, char ** mess
 		return KO;
 	}
 
+	/* The Process keeps its own copy of argv, as argv is freed
+	 * by _daemon_parse_line */
+	for (argc = 0; argv[argc] != NULL; argc++)
+		;
+	ps_argv = malloc0 (sizeof (char *) * (argc + 1));
+	if (ps_argv == NULL)
+		logger_log (self->_log, CRITICAL, "_daemon_action_add:malloc0");
+	for (i = 0; i < argc; i++) {
+		ps_argv[i] = strdup (argv[i]);
+		if (ps_argv[i] == NULL)
+			logger_log (self->_log, CRITICAL, "_daemon_action_add:strdup");
+	}
+
 	/* Create Process:  */
-	p = process_new (argv);
+	p = process_new (ps_argv);
 	if (p == NULL)
 		logger_log (self->_log, CRITICAL, 
 					"_daemon_parse_line:process_new");
@@ -796,7 +880,7 @@ static MessageType _daemon_action_list (Daemon * self, char ** message)
 	size_t slen;
 
 	/* Get the number of Processes in the list */
-	len = list_len (self->_pslist);
+	len = pslist_len (self->_pslist);
 
 	if (len == 0)
 		return OK;
@@ -846,14 +930,15 @@ static MessageType _daemon_action_list (Daemon * self, char ** message)
 }
 
 /* 
- * Move Process in PsList
+ * Move Processes in PsList
  * args:   Daemon, additional arguments, pointer to return message string
  * return: MessageType
  */
 static MessageType _daemon_action_move (Daemon * self, char ** argv, char ** message)
 {
-	char * src = NULL, * dst = NULL;
-	int src_i, dst_i;
+	char * src = NULL, * dst = NULL, * end;
+	Process ** ps = NULL;
+	int n_ps = 0, dst_i;
 
 	/* Check for the required extra arguments */
 	if (*argv != NULL)
@@ -866,43 +951,175 @@ static MessageType _daemon_action_move (Daemon * self, char ** argv, char ** mes
 	}
 	if (src == NULL || dst == NULL) {
 		logger_log (self->_log, WARNING, "Expected: 'mv UID DEST'");
-		*message = strdup ("Expected: 'mv UID DEST'\n");
+		*message = strdup ("Expected: 'mv UID[-UID][,...] DEST|front|back'\n");
 		if (*message == NULL)
 			logger_log (self->_log, CRITICAL, "_daemon_action_move:strdup");
 		return KO;
 	}
 
-	/* TODO: check if src contains a range (eg : 2-4) */
-
-	/* Convert the arguments to int */
-	errno = 0;
-	src_i = strtol (src, NULL, 10);
-	if (errno != 0) {
-		*message = strdup ("Expected: 'mv UID DEST'\n");
-		if (*message == NULL)
-			logger_log (self->_log, CRITICAL, "_daemon_action_move:strdup");
-		return KO;
+	/* Convert the destination to an index */
+	if (strcmp (dst, "front") == 0 || strcmp (dst, "first") == 0)
+		dst_i = 0;
+	else if (strcmp (dst, "back") == 0 || strcmp (dst, "last") == 0)
+		dst_i = -1;
+	else {
+		errno = 0;
+		dst_i = strtol (dst, &end, 10);
+		if (errno != 0 || end == dst || *end != '\0' || dst_i < -1) {
+			*message = strdup ("Expected: 'mv UID[-UID][,...] DEST|front|back'\n");
+			if (*message == NULL)
+				logger_log (self->_log, CRITICAL, "_daemon_action_move:strdup");
+			return KO;
+		}
 	}
-	dst_i = strtol (dst, NULL, 10);
-	if (errno != 0) {
-		*message = strdup ("Expected: 'mv UID DEST'\n");
-		if (*message == NULL)
-			logger_log (self->_log, CRITICAL, "_daemon_action_move:strdup");
+
+	/* Get the Processes to move, in the given order */
+	n_ps = _daemon_get_uids (self, src, &ps, message);
+	if (n_ps < 1)
 		return KO;
-	}
 
-	/* Get the index of the process based on its uid */
-	src_i = pslist_get_uid_index (self->_pslist, src_i);
+	/* Moving to a position past the end of the list means moving to the
+	 * end of the list */
+	if (dst_i + n_ps > pslist_len (self->_pslist))
+		dst_i = -1;
 
-	logger_log (self->_log, DEBUG, "Moving processes: %d to %d", src_i, dst_i);
+	logger_log (self->_log, DEBUG, "Moving %d processes to %d", n_ps, dst_i);
 
 	/* Move the processes */
-	if (pslist_move_items (self->_pslist, src_i, 1, dst_i))
-		logger_log (self->_log, CRITICAL, "_daemon_action_move:pslist_move_items");
+	if (pslist_move_ps (self->_pslist, ps, n_ps, dst_i))
+		logger_log (self->_log, CRITICAL, "_daemon_action_move:pslist_move_ps");
+
+	free (ps);
 
 	return OK;
 }
 
+/* 
+ * Get the Processes matching a list of UIDs and UID ranges, 
+ * eg: "3,7-9,5", ranges are expanded in increasing order and UIDs
+ * listed several times are only returned once
+ * args:   Daemon, UIDs string, pointer to the array of Processes (to be
+ *		   freed after use), pointer to return message string
+ * return: number of Processes, or -1 on error
+ */
+static int _daemon_get_uids (Daemon * self, char * uids, Process *** ps,
+							 char ** message)
+{
+	HashTable * seen;
+	Process * p, ** tmp;
+	OsNode * node;
+	char * current = uids, * end;
+	int first, last, uid, n = 0, size = 0, len;
+
+	*ps = NULL;
+
+	seen = hashtable_new ();
+	if (seen == NULL)
+		logger_log (self->_log, CRITICAL, "_daemon_get_uids:hashtable_new");
+
+	while (*current != '\0')
+	{
+		/* Parse "UID" or "UID-UID" */
+		errno = 0;
+		first = last = strtol (current, &end, 10);
+		if (errno == 0 && end != current && *end == '-') {
+			current = end + 1;
+			last = strtol (current, &end, 10);
+		}
+		if (errno != 0 || end == current || first < 0 || last < first ||
+			(*end != ',' && *end != '\0'))
+		{
+			*message = msprintf ("Invalid UID '%s'\n", uids);
+			if (*message == NULL)
+				logger_log (self->_log, CRITICAL, "_daemon_get_uids:msprintf");
+			n = -1;
+			break;
+		}
+		current = (*end == ',') ? end + 1 : end;
+
+		/* Make sure the array can fit the whole range */
+		len = pslist_len (self->_pslist);
+		if (last - first < len)
+			len = last - first + 1;
+		if (n + len > size) {
+			size = (n + len) * 2;
+			tmp = realloc (*ps, size * sizeof (Process *));
+			if (tmp == NULL)
+				logger_log (self->_log, CRITICAL, "_daemon_get_uids:realloc");
+			*ps = tmp;
+		}
+
+		if (first == last) {
+			p = pslist_get_ps_by_uid (self->_pslist, first);
+			if (p == NULL) {
+				*message = msprintf ("Unknown UID '%d'\n", first);
+				if (*message == NULL)
+					logger_log (self->_log, CRITICAL, "_daemon_get_uids:msprintf");
+				n = -1;
+				break;
+			}
+			if (hashtable_get (seen, p->uid) == NULL) {
+				hashtable_insert (seen, p->uid, p);
+				(*ps)[n++] = p;
+			}
+		}
+		else if (last - first < pslist_len (self->_pslist))
+		{
+			/* Look up each UID of the range */
+			for (uid = first; uid <= last; uid++) {
+				p = pslist_get_ps_by_uid (self->_pslist, uid);
+				if (p != NULL && hashtable_get (seen, uid) == NULL) {
+					hashtable_insert (seen, uid, p);
+					(*ps)[n++] = p;
+				}
+			}
+		}
+		else
+		{
+			/* The range is wider than the list, go through the list and
+			 * sort the matching Processes */
+			len = n;
+			for (node = ostree_first (self->_pslist->_tree); node != NULL;
+				 node = ostree_next (node))
+			{
+				p = node->item;
+				if (p->uid >= first && p->uid <= last &&
+					hashtable_get (seen, p->uid) == NULL) {
+					hashtable_insert (seen, p->uid, p);
+					(*ps)[n++] = p;
+				}
+			}
+			qsort (*ps + len, n - len, sizeof (Process *), _daemon_uid_cmp);
+		}
+	}
+
+	hashtable_delete (seen);
+
+	if (n == 0) {
+		*message = msprintf ("No Process matches '%s'\n", uids);
+		if (*message == NULL)
+			logger_log (self->_log, CRITICAL, "_daemon_get_uids:msprintf");
+		n = -1;
+	}
+
+	if (n == -1) {
+		free (*ps);
+		*ps = NULL;
+	}
+
+	return n;
+}
+
+/* 
+ * Compare the UIDs of two Processes, for qsort ()
+ * args:   pointers to Process pointers
+ * return: negative, 0 or positive
+ */
+static int _daemon_uid_cmp (const void * a, const void * b)
+{
+	return (*(Process * const *) a)->uid - (*(Process * const *) b)->uid;
+}
+
 /*
  * Pause a Process from PsList
  * args:   Daemon, additional arguments, pointer to return message string
@@ -954,8 +1171,8 @@ static MessageType _daemon_action_pause (Daemon * self, char ** argv, char ** me
 		return KO;
 	}
 
-	if (process_pause (p))
-		logger_log (self->_log, CRITICAL, "_daemon_action_pause:process_pause");
+	if (pslist_pause_ps (self->_pslist, p))
+		logger_log (self->_log, CRITICAL, "_daemon_action_pause:pslist_pause_ps");
 
 	/* Unblock signals */
 	_daemon_unblock_signals (self);
@@ -1102,8 +1319,8 @@ static MessageType _daemon_action_resume (Daemon * self, char ** argv, char ** m
 		return KO;
 	}
 
-	if (process_resume (p))
-		logger_log (self->_log, CRITICAL, "_daemon_action_resume:process_resume");
+	if (pslist_resume_ps (self->_pslist, p))
+		logger_log (self->_log, CRITICAL, "_daemon_action_resume:pslist_resume_ps");
 
 	/* TODO: check if process can be started? */
 
@@ -1122,8 +1339,7 @@ static MessageType _daemon_action_resume (Daemon * self, char ** argv, char ** m
 static MessageType _daemon_action_kill (Daemon * self, char ** argv, char ** message, int sig)
 {
 	Process * p;
-	int * l_running = NULL;	/* array of Processes running */
-	int uid, n_running, i;
+	int uid;
 
 	/* Block signals */
 	_daemon_block_signals (self);
@@ -1146,22 +1362,10 @@ static MessageType _daemon_action_kill (Daemon * self, char ** argv, char ** mes
 	/* Argument can be "all" or UID */
 	if (strcmp (*argv, "all") == 0)
 	{
-		/* Get number of Processes running */
-		n_running = pslist_get_nps (self->_pslist, RUNNING, NULL);
-
-		/* Get list of Processes running */
-		l_running  = malloc0 (n_running * sizeof (int));
-		if (l_running == NULL)
-			logger_log (self->_log, CRITICAL, "_daemon_action_kill:malloc0");
-		pslist_get_nps (self->_pslist, RUNNING, l_running);
-
 		/* Terminate each running process */
-		for (i = 0; i < n_running; i++)
+		for (p = pslist_get_first (self->_pslist, RUNNING); p != NULL;
+			 p = pslist_get_next (self->_pslist, p))
 		{
-			p = pslist_get_ps (self->_pslist, l_running[i]);
-			if (p == NULL)
-				logger_log (self->_log, CRITICAL,
-							"_daemon_action_kill:pslist_get_ps");
 			if (process_kill (p, sig))
 				logger_log (self->_log, CRITICAL, 
 						"_daemon_action_kill:process_terminate");
@@ -1236,8 +1440,8 @@ Actions:\n\
         Add <command> to the queue\n\
 	list\n\
         List all command in the queue\n\
-    move UID DST\n\
-        Move command UID to position DST in the queue\n\
+    move UID[-UID][,...] DST|front|back\n\
+        Move commands UID (in the given order) to position DST in the queue\n\
     term[inate] UID|all\n\
         Terminate the command UID\n\
     kill UID\n\
@@ -25,7 +25,7 @@
 
 #include "logger.h"
 #include "pslist.h"
-#include "messagelist.h"
+#include "connection.h"
 
 typedef struct _Daemon Daemon;
 
@@ -39,9 +39,9 @@ struct _Daemon
 	char * _log_path;
 	short int _running;		/* whether the daemon is running or not */
 	int _epfd;				/* epoll fd */
+	int _sigfd;				/* signalfd notified on SIGCHLD */
 	PsList * _pslist;		/* Process list, these should only be accessed while
 							   signals are blocked with _daemon_block_signals */
-	MessageList * _mlist;	/* List of messages to be sent to sockets */
 	long _ncpus;			/* Number of available CPUs */
 	sigset_t _sig_mask;		/* Mask to block signals*/
 };
@@ -0,0 +1,206 @@
+/* 
+ * This file is part of mq.
+ * mq - src/hashtable.c
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "hashtable.h"
+#include "utils.h"
+
+/* Private methods */
+static int _hashtable_bucket (HashTable * self, int key);
+static int _hashtable_find (HashTable * self, int key);
+static int _hashtable_resize (HashTable * self, int size);
+
+/* 
+ * Create and initialise the HashTable
+ * args:   void
+ * return: HashTable or NULL on error
+ */
+HashTable * hashtable_new (void)
+{
+	HashTable * table = malloc0 (sizeof (HashTable));
+	if (table == NULL)
+		return NULL;
+
+	table->_entries = malloc0 (HT_MIN_SIZE * sizeof (HashEntry));
+	if (table->_entries == NULL) {
+		free (table);
+		return NULL;
+	}
+
+	table->_size = HT_MIN_SIZE;
+	table->_len = 0;
+
+	return table;
+}
+
+/* Delete and free the HashTable (but not the items)
+ * args: HashTable
+ * return: void
+ */
+void hashtable_delete (HashTable * self)
+{
+	free (self->_entries);
+	free (self);
+}
+
+/*
+ * Returns the number of items in the HashTable
+ * args:   HashTable
+ * return: number of items
+ */
+int hashtable_len (HashTable * self)
+{
+	return self->_len;
+}
+
+/* 
+ * Add an item to the HashTable, replacing any item with the same key
+ * args:   HashTable, key, item (can't be NULL)
+ * return: 0 on success, 1 on error
+ */
+int hashtable_insert (HashTable * self, int key, void * item)
+{
+	int i;
+
+	if (item == NULL)
+		return 1;
+
+	/* Keep the load factor under 3/4 */
+	if ((self->_len + 1) * 4 > self->_size * 3)
+		if (_hashtable_resize (self, self->_size * 2))
+			return 1;
+
+	i = _hashtable_find (self, key);
+	if (self->_entries[i].item == NULL)
+		self->_len++;
+
+	self->_entries[i].key = key;
+	self->_entries[i].item = item;
+
+	return 0;
+}
+
+/*
+ * Remove the item with the given key from the HashTable
+ * args:   HashTable, key
+ * return: 0 on success, 1 if key not found
+ */
+int hashtable_remove (HashTable * self, int key)
+{
+	int i, j, k;
+
+	i = _hashtable_find (self, key);
+	if (self->_entries[i].item == NULL)
+		return 1;
+
+	/* Shift back the following entries of the cluster which would
+	 * otherwise become unreachable, this avoids using tombstones */
+	for (j = (i + 1) & (self->_size - 1); self->_entries[j].item != NULL;
+		 j = (j + 1) & (self->_size - 1))
+	{
+		k = _hashtable_bucket (self, self->_entries[j].key);
+
+		/* Only move the entry if its bucket isn't cyclically in ]i, j] */
+		if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+			continue;
+
+		self->_entries[i] = self->_entries[j];
+		i = j;
+	}
+
+	self->_entries[i].item = NULL;
+	self->_len--;
+
+	return 0;
+}
+
+/* 
+ * Get the item with the given key
+ * args:   HashTable, key
+ * return: item or NULL if not found
+ */
+void * hashtable_get (HashTable * self, int key)
+{
+	return self->_entries[_hashtable_find (self, key)].item;
+}
+
+
+/* Private methods */
+
+/* 
+ * Return the bucket a key hashes to
+ * args:   HashTable, key
+ * return: bucket index
+ */
+static int _hashtable_bucket (HashTable * self, int key)
+{
+	/* Fibonacci hashing, spreads sequential keys (uids, pids) */
+	return ((unsigned int) key * 2654435769u) & (self->_size - 1);
+}
+
+/* 
+ * Look for the bucket holding key, or the empty bucket where it belongs
+ * args:   HashTable, key
+ * return: bucket index
+ */
+static int _hashtable_find (HashTable * self, int key)
+{
+	int i;
+
+	for (i = _hashtable_bucket (self, key); self->_entries[i].item != NULL;
+		 i = (i + 1) & (self->_size - 1))
+	{
+		if (self->_entries[i].key == key)
+			break;
+	}
+
+	return i;
+}
+
+/* 
+ * Change the number of buckets and rehash all the items
+ * args:   HashTable, new size (power of 2)
+ * return: 0 on success, 1 on error
+ */
+static int _hashtable_resize (HashTable * self, int size)
+{
+	HashEntry * old_entries = self->_entries;
+	int old_size = self->_size;
+	int i, j;
+
+	self->_entries = malloc0 (size * sizeof (HashEntry));
+	if (self->_entries == NULL) {
+		self->_entries = old_entries;
+		return 1;
+	}
+	self->_size = size;
+
+	for (i = 0; i < old_size; i++) {
+		if (old_entries[i].item == NULL)
+			continue;
+		j = _hashtable_find (self, old_entries[i].key);
+		self->_entries[j] = old_entries[i];
+	}
+
+	free (old_entries);
+
+	return 0;
+}
@@ -0,0 +1,50 @@
+/* 
+ * This file is part of mq.
+ * mq - src/hashtable.h
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#define HT_MIN_SIZE	16	/* initial number of buckets, must be a power of 2 */
+
+typedef struct _HashEntry HashEntry;
+
+struct _HashEntry
+{
+	int key;
+	void * item;		/* NULL if the bucket is empty */
+};
+
+typedef struct _HashTable HashTable;
+
+/* Open addressing hash table mapping int keys to (non NULL) items */
+struct _HashTable 
+{
+	HashEntry * _entries;
+	int _size;			/* number of buckets */
+	int _len;			/* number of items */
+};
+
+HashTable * hashtable_new (void);
+void hashtable_delete (HashTable * self);
+int hashtable_len (HashTable * self);
+int hashtable_insert (HashTable * self, int key, void * item);
+int hashtable_remove (HashTable * self, int key);
+void * hashtable_get (HashTable * self, int key);
+
+#endif /* HASHTABLE_H */
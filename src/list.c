@@ -19,10 +19,15 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "list.h"
 #include "utils.h"
 
+/* Private methods */
+static int _list_resize (List * self, int size);
+static void _list_reverse (List * self, int start, int end);
+
 /* 
  * Create and initialise the List
  * args:   void
@@ -34,12 +39,13 @@ List * list_new (void)
 	if (list == NULL)
 		return NULL;
 
-	/* Initial size is CHUNK_SIZE elements */
-	list->_list = malloc0 (CHUNK_SIZE * sizeof (List *));
+	/* Initial size is LIST_MIN_SIZE elements */
+	list->_list = malloc0 (LIST_MIN_SIZE * sizeof (void *));
 	if (!list->_list)
 		return NULL;
 
 	list->_len = 0;
+	list->_size = LIST_MIN_SIZE;
 
 	return list;
 }
@@ -71,15 +77,11 @@ int list_len (List * self)
  */
 int list_append (List * self, void * item)
 {
-	/* If the current list is full we extend it by CHUNK_SIZE */
-	if (self->_len % CHUNK_SIZE == 0) {
-		void ** tmp_list;
-		tmp_list = realloc (self->_list, (self->_len + CHUNK_SIZE) * sizeof (List *));
-		if (tmp_list == NULL)
+	/* If the current list is full we double its size, which makes
+	 * appending amortized O(1) */
+	if (self->_len == self->_size) {
+		if (_list_resize (self, self->_size * 2))
 			return 1;
-		else
-			self->_list = tmp_list;
-
 	}
 
 	self->_list[self->_len] = item;
@@ -94,7 +96,7 @@ int list_append (List * self, void * item)
  */
 int list_remove (List * self, void * item)
 {
-	int i, j;
+	int i;
 
 	/* Look for the item in list */
 	for (i = 0; i < self->_len && self->_list[i] != item; i++)
@@ -104,23 +106,42 @@ int list_remove (List * self, void * item)
 		/* Couldn't find item */
 		return 1;
 
-	/* Left shift all items after our item, effectively removing it */
-	for (j = i; j < self->_len - 1; j ++)
-		self->_list[j] = self->_list[j + 1];
+	return list_remove_index (self, i);
+}
 
-	/* If we have more than CHUNK_SIZE free elements we compress the list*/
-	if (self->_len % CHUNK_SIZE == 0) {
-		void ** tmp_list;
-		tmp_list = realloc (self->_list, (self->_len) * sizeof (List *));
-		if (tmp_list == NULL)
-			return 1;
-		else
-			self->_list = tmp_list;
+/*
+ * Remove the item at the given index from the list
+ * args:   List, index
+ * return: 0 on sucess, 1 if index is out of range, -1 on error
+ */
+int list_remove_index (List * self, int index)
+{
+	return list_remove_items (self, index, 1);
+}
 
-	}
+/*
+ * Remove count items starting at the given index from the list
+ * args:   List, index, number of items
+ * return: 0 on sucess, 1 if the items are out of range, -1 on error
+ */
+int list_remove_items (List * self, int index, int count)
+{
+	/* Check that the given items are within the range */
+	if ((index < 0) || (count < 1) || (index + count > self->_len))
+		return 1;
+
+	/* Left shift all items after our items, effectively removing them */
+	memmove (&self->_list[index], &self->_list[index + count],
+			 (self->_len - index - count) * sizeof (void *));
 
 	/* Decrease the lengh of the list */
-	self->_len--;
+	self->_len -= count;
+
+	/* If the list is less than a quarter full we halve it, a failure
+	 * to do so isn't an error as the list is still consistent */
+	while (self->_size > LIST_MIN_SIZE && self->_len < self->_size / 4)
+		if (_list_resize (self, self->_size / 2))
+			break;
 
 	return 0;
 }
@@ -147,50 +168,82 @@ void * list_get_item (List * self, int index)
  */
 int list_move_items (List * self, int start, int count, int dest)
 {
-	int i, j;
-	void * p;
+	if (count < 1)
+		return 1;
 
 	/* Check that the starting position is within the list range */
 	if (start < 0 || start >= self->_len)
 		return 1;
 
-	/* Check that the destination position is within the list range */
-	if (dest < 0 || dest >= self->_len)
+	/* Check that elements from start until start + count are in the range */
+	if (start + count > self->_len)
 		return 1;
 
-	/* Check that elements from start until start + count are in the range */
-	if (start + count - 1 >= self->_len)
+	/* The items end up at [dest, dest + count[ */
+	if (dest == -1)
+		dest = self->_len - count;
+
+	/* Check that the destination position is within the list range */
+	if (dest < 0 || dest + count > self->_len)
 		return 1;
 
 	if (start == dest)
 		/* Nothing to do */
 		return 0;
 
+	/* Moving the items is a rotation of the range spanning both the
+	 * items and their destination, done in place with three reversals */
 	if (start < dest)
 	{
-		for (i = count - 1; i >= 0; i--)
-		{
-			for (j = start; j < dest; j++)
-			{
-				p = self->_list[j + i + 1];
-				self->_list[j + i + 1] = self->_list[j + i];
-				self->_list[j + i] = p;
-			}
-		}
+		_list_reverse (self, start, start + count);
+		_list_reverse (self, start + count, dest + count);
+		_list_reverse (self, start, dest + count);
 	}
-
-	if (start > dest)
+	else
 	{
-		for (i = 0; i < count; i++)
-		{
-			for (j = start; j > dest; j--)
-			{
-				p = self->_list[j + i - 1];
-				self->_list[j + i - 1] = self->_list[j + i];
-				self->_list[j + i] = p;
-			}
-		}
+		_list_reverse (self, dest, start);
+		_list_reverse (self, start, start + count);
+		_list_reverse (self, dest, start + count);
 	}
 
 	return 0;
 }
+
+
+/* Private methods */
+
+/*
+ * Change the number of items the list can hold
+ * args:   List, new size
+ * return: 0 on success, 1 on error
+ */
+static int _list_resize (List * self, int size)
+{
+	void ** tmp_list;
+
+	tmp_list = realloc (self->_list, size * sizeof (void *));
+	if (tmp_list == NULL)
+		return 1;
+
+	self->_list = tmp_list;
+	self->_size = size;
+
+	return 0;
+}
+
+/*
+ * Reverse the order of the items in [start, end[
+ * args:   List, first index, last index (excluded)
+ * return: void
+ */
+static void _list_reverse (List * self, int start, int end)
+{
+	void * p;
+
+	for (end--; start < end; start++, end--)
+	{
+		p = self->_list[start];
+		self->_list[start] = self->_list[end];
+		self->_list[end] = p;
+	}
+}
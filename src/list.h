@@ -20,7 +20,7 @@
 #ifndef LIST_H
 #define LIST_H
 
-#define CHUNK_SIZE	10	/* amount to increase/decrease list's size */
+#define LIST_MIN_SIZE	16	/* initial capacity of the list */
 
 
 typedef struct _List List;
@@ -29,6 +29,7 @@ struct _List
 {
 	void ** _list;
 	int _len;
+	int _size;		/* number of items the list can hold */
 };
 
 List * list_new (void);
@@ -36,6 +37,8 @@ void list_delete(List * self);
 int list_len (List * self);
 int list_append (List * self, void * item);
 int list_remove (List * self, void * item);
+int list_remove_index (List * self, int index);
+int list_remove_items (List * self, int index, int count);
 void * list_get_item (List * self, int index);
 int list_move_items (List * self, int origin, int count, int dest);
 
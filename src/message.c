@@ -18,30 +18,74 @@
  */
 
 #include <stdlib.h>
-#include <sys/socket.h>
 #include <string.h>
 
 #include "message.h"
 #include "utils.h"
 
-/* Private methods */
-static char * _message_get_next_line (Message * self);
-
 /* 
- * Create and initialise a message
- * args:   message type, message string
+ * Create and initialise a message, the content is encoded right away
+ * as a sequence of lines each prefixed by OUT (or ERR if type is not
+ * OK), followed by type as "exit code"
+ * args:   message type, message string (freed by message_new)
  * return: Message object or NULL on error
  */
-Message * message_new (MessageType type, char * content, int sock)
+Message * message_new (MessageType type, char * content)
 {
 	Message * message = malloc0 (sizeof (Message));
+	MessageType ptype;
+	char * start, * end, * p;
+	size_t len, n_lines = 0;
 
 	if (message == NULL)
 		return NULL;
 
 	message->_type = type;
-	message->_content = content;
-	message->sock = sock;
+	message->_sent = 0;
+
+	/* Set the type send to prefix content lines */
+	if (type == OK)
+		ptype = OUT;
+	else
+		ptype = ERR;
+
+	/* Count the lines (a last line missing its '\n' gets one) */
+	len = (content == NULL) ? 0 : strlen (content);
+	for (p = content; p != NULL && p < content + len; n_lines++) {
+		p = memchr (p, '\n', content + len - p);
+		if (p != NULL)
+			p++;
+	}
+
+	message->_len = len + n_lines * sizeof (MessageType) + sizeof (MessageType);
+	if (len > 0 && content[len - 1] != '\n')
+		message->_len++;
+
+	message->_data = malloc (message->_len);
+	if (message->_data == NULL) {
+		free (message);
+		return NULL;
+	}
+
+	/* Copy each line after its prefix */
+	p = message->_data;
+	for (start = content; start != NULL && start < content + len; start = end + 1)
+	{
+		end = memchr (start, '\n', content + len - start);
+		if (end == NULL)
+			end = content + len;
+
+		memcpy (p, &ptype, sizeof (MessageType));
+		p += sizeof (MessageType);
+		memcpy (p, start, end - start);
+		p += end - start;
+		*p++ = '\n';
+	}
+
+	/* Add the "exit code" */
+	memcpy (p, &type, sizeof (MessageType));
+
+	free (content);
 
 	return message;
 }
@@ -53,95 +97,30 @@ Message * message_new (MessageType type, char * content, int sock)
  */
 void message_del (Message * self)
 {
-	free (self->_content);
+	free (self->_data);
 	free (self);
 }
 
 /*
- * Send the current message on the socket
- * args:   Message
- * return: 0 on success, 1 on eror
+ * Return the part of the message which hasn't been sent yet
+ * args:   Message, pointer to store the length
+ * return: pointer to the data
  */
-int message_send (Message * self)
+char * message_get_data (Message * self, size_t * len)
 {
-	char * line; 
-	MessageType ptype;
-
-	/* Check that the socket is valid */
-	if (self->sock < 1)
-		return 1;
+	*len = self->_len - self->_sent;
 
-	/* Set the type send to prefix content lines */
-	if (self->_type == OK)
-		ptype = OUT;
-	else
-		ptype = ERR;
-
-	/* Send each line from the content (if any) */
-	while ((line = _message_get_next_line (self)) != NULL)
-	{
-		/* Send the message type */
-		if (send (self->sock, &ptype, sizeof (MessageType), 0) == -1) {
-			free (line);
-			return 1;
-		}
-
-		/* Send the line */
-		if (send (self->sock, line, strlen (line), 0) == -1) {
-			free (line);
-			return 1;
-		}
-
-		free (line);
-	}
-
-	/* Send the "exit code" */
-	if (send (self->sock, &self->_type, sizeof (MessageType), 0) == -1)
-		return 1;
-
-	return 0;
+	return self->_data + self->_sent;
 }
 
-
-/* Private methods */
-
-/* 
- * Return the next line from message
- * args:   Message
- * return: next line or NULL
+/*
+ * Record that some bytes of the message have been sent
+ * args:   Message, number of bytes sent
+ * return: 1 if the whole message has been sent, else 0
  */
-static char * _message_get_next_line (Message * self)
+int message_sent (Message * self, size_t len)
 {
-	static int start = 0;
-	char * line, * startp;
-	int len;
-	
-	if (self->_content == NULL)
-		return NULL;
-
-	/* Set the starting pointer position */
-	startp = self->_content + start;
-
-	/* Count the number of char until the first \n */
-	for (len = 0; startp[len] != '\0' && startp[len] != '\n'; len++)
-		;
-
-	/* If we're at \0 we've already sent the last line in the previous call */
-	if (startp[len] == '\0') {
-		/* Reset start index */
-		start = 0;
-		return NULL;
-	}
+	self->_sent += len;
 
-	line = malloc0 (sizeof (char *) * (len + 2));
-	if (line == NULL)
-		return NULL;	/* FIXME: the error should be reported somehow */
-		
-	strncpy (line, startp, len + 2);
-	line[len + 1] = '\0';
-	
-	/* Advance the starting point */
-	start += len + 1;
-
-	return line;
+	return self->_sent >= self->_len;
 }
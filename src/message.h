@@ -20,6 +20,8 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
 
+#include <stddef.h>
+
 #define PID_FILENAME ".mq.pid"
 #define SOCK_FILENAME ".mq.sock"
 #define LOG_FILENAME ".mq.log"
@@ -37,12 +39,14 @@ typedef struct _Message Message;
 struct _Message 
 {
 	MessageType _type;
-	char * _content;	/* content of the message */
-	int sock;			/* socket the message should be written to */
+	char * _data;		/* message encoded as it is sent on the socket */
+	size_t _len;		/* length of _data */
+	size_t _sent;		/* number of bytes of _data already sent */
 };
 
-Message * message_new (MessageType type, char * message, int sock);
+Message * message_new (MessageType type, char * content);
 void message_del (Message * self);
-int message_send (Message * self);
+char * message_get_data (Message * self, size_t * len);
+int message_sent (Message * self, size_t len);
 
 #endif /* CLIENT_H */
@@ -0,0 +1,319 @@
+/* 
+ * This file is part of mq.
+ * mq - src/ostree.c
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "ostree.h"
+#include "utils.h"
+
+/* Private methods */
+static int _ostree_size (OsNode * node);
+static void _ostree_update (OsNode * node);
+static void _ostree_split (OsNode * node, int index, OsNode ** left,
+						   OsNode ** right);
+static OsNode * _ostree_merge (OsNode * left, OsNode * right);
+static void _ostree_free (OsNode * node);
+
+/* 
+ * Create and initialise the OsTree
+ * args:   void
+ * return: OsTree or NULL on error
+ */
+OsTree * ostree_new (void)
+{
+	OsTree * tree = malloc0 (sizeof (OsTree));
+	if (tree == NULL)
+		return NULL;
+
+	tree->_root = NULL;
+
+	return tree;
+}
+
+/* Delete and free the tree (but not the items)
+ * args: OsTree
+ * return: void
+ */
+void ostree_delete (OsTree * self)
+{
+	_ostree_free (self->_root);
+	free (self);
+}
+
+/*
+ * Returns the number of items in the tree
+ * args:   OsTree
+ * return: number of items
+ */
+int ostree_len (OsTree * self)
+{
+	return _ostree_size (self->_root);
+}
+
+/* 
+ * Insert an item so that it ends up at the given index
+ * args:   OsTree, index (0 to len), item
+ * return: node holding the item, or NULL on error
+ */
+OsNode * ostree_insert (OsTree * self, int index, void * item)
+{
+	OsNode * node, * left, * right;
+
+	if (index < 0 || index > ostree_len (self))
+		return NULL;
+
+	node = malloc0 (sizeof (OsNode));
+	if (node == NULL)
+		return NULL;
+
+	node->item = item;
+	node->_size = 1;
+	node->_prio = rand ();
+
+	_ostree_split (self->_root, index, &left, &right);
+	self->_root = _ostree_merge (_ostree_merge (left, node), right);
+	self->_root->_parent = NULL;
+
+	return node;
+}
+
+/*
+ * Remove and free a node from the tree
+ * args:   OsTree, node
+ * return: void
+ */
+void ostree_remove (OsTree * self, OsNode * node)
+{
+	OsNode * child, * p;
+
+	/* The merged children have a lower priority than node, so they can
+	 * take its place without breaking the heap order */
+	child = _ostree_merge (node->_left, node->_right);
+	if (child != NULL)
+		child->_parent = node->_parent;
+
+	if (node->_parent == NULL)
+		self->_root = child;
+	else if (node->_parent->_left == node)
+		node->_parent->_left = child;
+	else
+		node->_parent->_right = child;
+
+	/* Update the sizes up to the root */
+	for (p = node->_parent; p != NULL; p = p->_parent)
+		p->_size--;
+
+	free (node);
+}
+
+/* 
+ * Get the node at the given index
+ * args:   OsTree, index
+ * return: node at index, or NULL on error
+ */
+OsNode * ostree_get_node (OsTree * self, int index)
+{
+	OsNode * node = self->_root;
+
+	if (index < 0 || index >= ostree_len (self))
+		return NULL;
+
+	while (node != NULL)
+	{
+		if (index < _ostree_size (node->_left))
+			node = node->_left;
+		else if (index == _ostree_size (node->_left))
+			break;
+		else {
+			index -= _ostree_size (node->_left) + 1;
+			node = node->_right;
+		}
+	}
+
+	return node;
+}
+
+/* 
+ * Get the item at the given index
+ * args:   OsTree, index
+ * return: item at index, or NULL on error
+ */
+void * ostree_get_item (OsTree * self, int index)
+{
+	OsNode * node = ostree_get_node (self, index);
+
+	if (node == NULL)
+		return NULL;
+
+	return node->item;
+}
+
+/*
+ * Get the position of a node in the tree
+ * args:   OsTree, node
+ * return: index of the node
+ */
+int ostree_get_index (OsTree * self, OsNode * node)
+{
+	int index = _ostree_size (node->_left);
+
+	/* Add the nodes on the left of each ancestor we come from the right */
+	for (; node->_parent != NULL; node = node->_parent)
+		if (node->_parent->_right == node)
+			index += _ostree_size (node->_parent->_left) + 1;
+
+	return index;
+}
+
+/*
+ * Get the first node of the tree
+ * args:   OsTree
+ * return: first node, or NULL if the tree is empty
+ */
+OsNode * ostree_first (OsTree * self)
+{
+	OsNode * node = self->_root;
+
+	if (node == NULL)
+		return NULL;
+
+	while (node->_left != NULL)
+		node = node->_left;
+
+	return node;
+}
+
+/*
+ * Get the node following the given one
+ * args:   node
+ * return: next node, or NULL if node is the last one
+ */
+OsNode * ostree_next (OsNode * node)
+{
+	if (node->_right != NULL) {
+		for (node = node->_right; node->_left != NULL; node = node->_left)
+			;
+		return node;
+	}
+
+	/* Go up until we come from a left child */
+	while (node->_parent != NULL && node->_parent->_right == node)
+		node = node->_parent;
+
+	return node->_parent;
+}
+
+
+/* Private methods */
+
+/* 
+ * Return the size of a subtree
+ * args:   node (can be NULL)
+ * return: number of nodes
+ */
+static int _ostree_size (OsNode * node)
+{
+	if (node == NULL)
+		return 0;
+
+	return node->_size;
+}
+
+/* 
+ * Update a node's size and its children's parent after they changed
+ * args:   node
+ * return: void
+ */
+static void _ostree_update (OsNode * node)
+{
+	node->_size = _ostree_size (node->_left) + _ostree_size (node->_right) + 1;
+
+	if (node->_left != NULL)
+		node->_left->_parent = node;
+	if (node->_right != NULL)
+		node->_right->_parent = node;
+}
+
+/* 
+ * Split a subtree in the first index nodes and the remaining ones
+ * args:   subtree, index, pointers to the resulting subtrees
+ * return: void
+ */
+static void _ostree_split (OsNode * node, int index, OsNode ** left,
+						   OsNode ** right)
+{
+	if (node == NULL) {
+		*left = NULL;
+		*right = NULL;
+		return;
+	}
+
+	if (index <= _ostree_size (node->_left)) {
+		_ostree_split (node->_left, index, left, &node->_left);
+		*right = node;
+	} else {
+		_ostree_split (node->_right, index - _ostree_size (node->_left) - 1,
+					   &node->_right, right);
+		*left = node;
+	}
+
+	_ostree_update (node);
+	node->_parent = NULL;
+}
+
+/* 
+ * Concatenate two subtrees
+ * args:   left subtree, right subtree
+ * return: merged subtree
+ */
+static OsNode * _ostree_merge (OsNode * left, OsNode * right)
+{
+	if (left == NULL)
+		return right;
+	if (right == NULL)
+		return left;
+
+	if (left->_prio > right->_prio) {
+		left->_right = _ostree_merge (left->_right, right);
+		_ostree_update (left);
+		left->_parent = NULL;
+		return left;
+	} else {
+		right->_left = _ostree_merge (left, right->_left);
+		_ostree_update (right);
+		right->_parent = NULL;
+		return right;
+	}
+}
+
+/* 
+ * Free all the nodes of a subtree
+ * args:   subtree
+ * return: void
+ */
+static void _ostree_free (OsNode * node)
+{
+	if (node == NULL)
+		return;
+
+	_ostree_free (node->_left);
+	_ostree_free (node->_right);
+	free (node);
+}
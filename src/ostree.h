@@ -0,0 +1,56 @@
+/* 
+ * This file is part of mq.
+ * mq - src/ostree.h
+ * Copyright (C) 2011 Mathias Andre <mathias@acronycal.org>
+ *
+ * mq is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * mq is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mq.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OSTREE_H
+#define OSTREE_H
+
+typedef struct _OsNode OsNode;
+
+struct _OsNode
+{
+	void * item;
+	OsNode * _left;
+	OsNode * _right;
+	OsNode * _parent;
+	int _size;				/* number of nodes in this subtree */
+	unsigned int _prio;		/* random heap priority */
+};
+
+typedef struct _OsTree OsTree;
+
+/* Order statistics tree: a sequence of items which can be accessed,
+ * inserted and removed at any position in O(log n). It is implemented
+ * as a treap ordered by position (implicit keys) */
+struct _OsTree
+{
+	OsNode * _root;
+};
+
+OsTree * ostree_new (void);
+void ostree_delete (OsTree * self);
+int ostree_len (OsTree * self);
+OsNode * ostree_insert (OsTree * self, int index, void * item);
+void ostree_remove (OsTree * self, OsNode * node);
+OsNode * ostree_get_node (OsTree * self, int index);
+void * ostree_get_item (OsTree * self, int index);
+int ostree_get_index (OsTree * self, OsNode * node);
+OsNode * ostree_first (OsTree * self);
+OsNode * ostree_next (OsNode * node);
+
+#endif /* OSTREE_H */
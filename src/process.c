@@ -52,6 +52,9 @@ Process * process_new (char ** argv)
 	process->_ret = 0;
 	process->to_remove = 0;
 	process->is_paused = 0;
+	process->_node = NULL;
+	process->_prev = NULL;
+	process->_next = NULL;
 
 	/* Increment the id */
 	id++;
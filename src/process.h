@@ -28,6 +28,8 @@
 #include <unistd.h>
 #include <signal.h>
 
+#include "ostree.h"
+
 typedef enum {
 	/* FIXME: is ANY necessary? */
 	ANY,		/* Matches any other state, used to get list of processes */
@@ -51,6 +53,9 @@ struct _Process
 	short int to_remove;	/* Indicate that the process should be 
 							   removed once done running */
 	short int is_paused;	/* Indicate that the process has been paused */
+	OsNode * _node;	/* Node holding the Process in PsList's tree */
+	Process * _prev;	/* Links in PsList's per state queues */
+	Process * _next;
 };
 
 Process * process_new (char ** argv);
@@ -23,14 +23,40 @@
 #include "pslist.h"
 #include "utils.h"
 
+/* Private methods */
+static PsQueue * _pslist_get_queue (PsList * self, Process * process);
+static void _pslist_queue_append (PsQueue * queue, Process * process);
+static void _pslist_queue_insert (PsQueue * queue, Process * process,
+								  Process * next);
+static void _pslist_queue_unlink (PsQueue * queue, Process * process);
+static void _pslist_ready_insert (PsList * self, Process * process);
+
 /* 
- * Wrapper around list_new ()
+ * Create and initialise the PsList
  * args:   void
  * return: PsList or NULL on error
  */
 PsList * pslist_new (void)
 {
-	return list_new ();
+	PsList * pslist = malloc0 (sizeof (PsList));
+	if (pslist == NULL)
+		return NULL;
+
+	pslist->_tree = ostree_new ();
+	if (pslist->_tree == NULL)
+		return NULL;
+
+	pslist->_pids = hashtable_new ();
+	if (pslist->_pids == NULL)
+		return NULL;
+
+	pslist->_uids = hashtable_new ();
+	if (pslist->_uids == NULL)
+		return NULL;
+
+	/* The queues and counters are zeroed by malloc0 */
+
+	return pslist;
 }
 
 /* Delete and free the list
@@ -39,17 +65,45 @@ PsList * pslist_new (void)
  */
 void pslist_delete(PsList * self)
 {
-	list_delete (self);
+	hashtable_delete (self->_uids);
+	hashtable_delete (self->_pids);
+	ostree_delete (self->_tree);
+	free (self);
+}
+
+/*
+ * Wrapper around ostree_len ()
+ * args:   PsList
+ * return: number of Processes in PsList
+ */
+int pslist_len (PsList * self)
+{
+	return ostree_len (self->_tree);
 }
 
 /* 
- * Wrapper around list_append ()
+ * Add a Process at the end of the list
  * args:   PsList, Process
  * return: 0 on success
  */
 int pslist_append (PsList * self, Process * process)
 {
-	return list_append (self, process);
+	process->_node = ostree_insert (self->_tree, pslist_len (self), process);
+	if (process->_node == NULL)
+		return 1;
+
+	if (hashtable_insert (self->_uids, process->uid, process)) {
+		ostree_remove (self->_tree, process->_node);
+		process->_node = NULL;
+		return 1;
+	}
+
+	/* The Process is last in the list, so it is also last in its queue */
+	if (_pslist_get_queue (self, process) != NULL)
+		_pslist_queue_append (_pslist_get_queue (self, process), process);
+	self->_count[process_get_state (process)]++;
+
+	return 0;
 }
 
 /*
@@ -57,30 +111,202 @@ int pslist_append (PsList * self, Process * process)
  * args:   PsList, pointer to Process
  * return: 0 on sucess, 1 if Process not found, -1 on error
  */
-int pslist_remove (List * self, Process * process)
+int pslist_remove (PsList * self, Process * process)
 {
-	return list_remove (self, process);
+	/* Check that the Process belongs to the list */
+	if (process->_node == NULL ||
+		hashtable_get (self->_uids, process->uid) != process)
+		return 1;
+
+	ostree_remove (self->_tree, process->_node);
+	process->_node = NULL;
+
+	if (_pslist_get_queue (self, process) != NULL)
+		_pslist_queue_unlink (_pslist_get_queue (self, process), process);
+	self->_count[process_get_state (process)]--;
+
+	hashtable_remove (self->_uids, process->uid);
+	/* The pid may already have been reused by another Process */
+	if (hashtable_get (self->_pids, process->_pid) == process)
+		hashtable_remove (self->_pids, process->_pid);
+
+	return 0;
 }
 
 /* 
- * Wrapper around list_get_item ()
+ * Wrapper around ostree_get_item ()
  * args:   Pslist, index
  * return: Process at index, or NULL on error
  */
 Process * pslist_get_ps (PsList * self, int index)
 {
-	return list_get_item (self, index);
+	return ostree_get_item (self->_tree, index);
 }
 
 /*
- * Wrapper around list_move_items ()
+ * Move count Processes from start to destination
  * args:   PsList, start position, number of items to move, 
  *		   destination position (or -1 to move to end of list)
  * return: 0 on success, 1 on error
  */
-int pslist_move_items (List * self, int start, int count, int dest)
+int pslist_move_items (PsList * self, int start, int count, int dest)
+{
+	Process ** ps;
+	OsNode * node;
+	int i, ret;
+
+	/* Check that elements from start until start + count are in the range */
+	if (count < 1 || start < 0 || start + count > pslist_len (self))
+		return 1;
+
+	ps = malloc0 (count * sizeof (Process *));
+	if (ps == NULL)
+		return 1;
+
+	node = ostree_get_node (self->_tree, start);
+	for (i = 0; i < count; i++, node = ostree_next (node))
+		ps[i] = node->item;
+
+	ret = pslist_move_ps (self, ps, count, dest);
+
+	free (ps);
+
+	return ret;
+}
+
+/*
+ * Move the given Processes so that they are next to each other, in the
+ * given order, starting at the destination position; this costs
+ * O(count log n) whatever the distance
+ * args:   PsList, array of distinct Processes, number of Processes,
+ *		   destination position (or -1 to move to end of list)
+ * return: 0 on success, 1 on error
+ */
+int pslist_move_ps (PsList * self, Process ** ps, int count, int dest)
+{
+	int i;
+
+	if (dest == -1)
+		dest = pslist_len (self) - count;
+
+	/* Check that the destination position is within the list range */
+	if (count < 1 || dest < 0 || dest + count > pslist_len (self))
+		return 1;
+
+	/* Take the Processes out of the tree (and of the ready queue, the
+	 * other Processes keep their relative order so only the moved ones
+	 * need to be requeued) */
+	for (i = 0; i < count; i++)
+	{
+		if (_pslist_get_queue (self, ps[i]) == &self->_ready)
+			_pslist_queue_unlink (&self->_ready, ps[i]);
+
+		ostree_remove (self->_tree, ps[i]->_node);
+		ps[i]->_node = NULL;
+	}
+
+	/* Put them back at their destination */
+	for (i = 0; i < count; i++)
+	{
+		ps[i]->_node = ostree_insert (self->_tree, dest + i, ps[i]);
+		if (ps[i]->_node == NULL)
+			return 1;
+	}
+
+	/* Starting from the last one so that each insertion finds its
+	 * successor right away */
+	for (i = count - 1; i >= 0; i--) {
+		if (_pslist_get_queue (self, ps[i]) == &self->_ready)
+			_pslist_ready_insert (self, ps[i]);
+	}
+
+	return 0;
+}
+
+/*
+ * Wrapper around process_run (), indexes the Process' pid
+ * args:   PsList, Process
+ * return: 0 on success
+ */
+int pslist_run_ps (PsList * self, Process * process)
+{
+	PsQueue * queue = _pslist_get_queue (self, process);
+	PsState state = process_get_state (process);
+
+	if (process_run (process))
+		return 1;
+
+	if (queue != NULL)
+		_pslist_queue_unlink (queue, process);
+	_pslist_queue_append (&self->_running, process);
+	self->_count[state]--;
+	self->_count[process_get_state (process)]++;
+
+	if (hashtable_insert (self->_pids, process->_pid, process))
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Wrapper around process_wait (), the pid is dropped from the index
+ * once the Process has terminated as it may be reused by the system
+ * args:   PsList, Process, siginfo_t from signal
+ * return: 0 on success
+ */
+int pslist_wait_ps (PsList * self, Process * process, siginfo_t * siginfo)
+{
+	PsQueue * queue = _pslist_get_queue (self, process);
+	PsState state = process_get_state (process);
+
+	if (process_wait (process, siginfo))
+		return 1;
+
+	if (process_get_state (process) == state)
+		return 0;
+
+	/* The Process has terminated */
+	_pslist_queue_unlink (queue, process);
+	_pslist_queue_append (&self->_done, process);
+	self->_count[state]--;
+	self->_count[process_get_state (process)]++;
+
+	hashtable_remove (self->_pids, process->_pid);
+
+	return 0;
+}
+
+/*
+ * Wrapper around process_pause (), a paused WAITING Process is
+ * taken out of the ready queue
+ * args:   PsList, Process
+ * return: 0 on success, 1 on error
+ */
+int pslist_pause_ps (PsList * self, Process * process)
+{
+	if (_pslist_get_queue (self, process) == &self->_ready)
+		_pslist_queue_unlink (&self->_ready, process);
+
+	return process_pause (process);
+}
+
+/*
+ * Wrapper around process_resume (), a resumed WAITING Process is
+ * put back in the ready queue
+ * args:   PsList, Process
+ * return: 0 on success, 1 on error
+ */
+int pslist_resume_ps (PsList * self, Process * process)
 {
-	return list_move_items (self, start, count, dest);
+	short int was_ready = (_pslist_get_queue (self, process) == &self->_ready);
+
+	if (process_resume (process))
+		return 1;
+
+	if (!was_ready && _pslist_get_queue (self, process) == &self->_ready)
+		_pslist_ready_insert (self, process);
+
+	return 0;
 }
 
 
@@ -93,13 +319,16 @@ int pslist_move_items (List * self, int start, int count, int dest)
 int pslist_get_nps (PsList * self, PsState state, int * list)
 {
 	int i, len = 0;
+	OsNode * node;
 	Process * p = NULL;
 
-	if (self->_len == 0)
+	if (pslist_len (self) == 0)
 		return 0;
 
-	for (i = 0; i < self->_len; i++) {
-		p = pslist_get_ps (self, i);
+	for (i = 0, node = ostree_first (self->_tree); node != NULL;
+		 i++, node = ostree_next (node))
+	{
+		p = node->item;
 		if ((state == ANY) || (process_get_state (p) == state)) {
 			if (list)
 				list[len] = i;
@@ -110,27 +339,56 @@ int pslist_get_nps (PsList * self, PsState state, int * list)
 	return len;
 }
 
+/*
+ * Get the number of processes in a given state
+ * args:   Pslist, state
+ * return: number of matching processes
+ */
+int pslist_count (PsList * self, PsState state)
+{
+	if (state == ANY)
+		return pslist_len (self);
+
+	return self->_count[state];
+}
+
+/*
+ * Get the first Process of a state's queue, WAITING Processes are
+ * returned in list order and paused ones are skipped
+ * args:   Pslist, state (WAITING or RUNNING)
+ * return: first Process or NULL if the queue is empty
+ */
+Process * pslist_get_first (PsList * self, PsState state)
+{
+	if (state == WAITING)
+		return self->_ready.head;
+	if (state == RUNNING)
+		return self->_running.head;
+
+	return NULL;
+}
+
+/*
+ * Get the Process following the given one in its state's queue
+ * args:   Pslist, Process
+ * return: next Process or NULL
+ */
+Process * pslist_get_next (PsList * self, Process * process)
+{
+	return process->_next;
+}
+
 /* 
- * Get the process with given PID
+ * Get the running process with given PID
  * args:   Pslist, PID
  * return: Process with PID, or NULL on error
  */
 Process * pslist_get_ps_by_pid (PsList * self, pid_t pid)
 {
-	int i;
-	Process * p;
-
 	if (pid < 1)
 		return NULL;
 
-	for (i = 0; i < self->_len; i++) {
-		p = pslist_get_ps (self, i);
-		if (process_get_pid (p) == pid)
-			return p;
-	}
-
-	/* pid not found */
-	return NULL;
+	return hashtable_get (self->_pids, pid);
 }
 
 /* 
@@ -140,20 +398,10 @@ Process * pslist_get_ps_by_pid (PsList * self, pid_t pid)
  */
 Process * pslist_get_ps_by_uid (PsList * self, int uid)
 {
-	int i;
-	Process * p;
-
 	if (uid < 0)
 		return NULL;
 
-	for (i = 0; i < self->_len; i++) {
-		p = pslist_get_ps (self, i);
-		if (p->uid == uid)
-			return p;
-	}
-
-	/* uid not found */
-	return NULL;
+	return hashtable_get (self->_uids, uid);
 }
 
 /*
@@ -163,15 +411,135 @@ Process * pslist_get_ps_by_uid (PsList * self, int uid)
  */
 int pslist_get_uid_index (PsList * self, int uid)
 {
-	int i;
-	Process * p;
+	Process * p = pslist_get_ps_by_uid (self, uid);
+
+	if (p == NULL)
+		/* uid not found */
+		return -1;
+
+	return pslist_get_ps_index (self, p);
+}
+
+/*
+ * Return the index of a Process in the list
+ * args:   Pslist, Process
+ * return: index of Process
+ */
+int pslist_get_ps_index (PsList * self, Process * process)
+{
+	return ostree_get_index (self->_tree, process->_node);
+}
 
-	for (i = 0; i < self->_len; i++) {
-		p = pslist_get_ps (self, i);
-		if (p->uid == uid)
-			return i;
+
+/* Private methods */
+
+/*
+ * Return the queue a Process belongs to given its state
+ * args:   PsList, Process
+ * return: PsQueue or NULL if the Process isn't queued (paused and WAITING)
+ */
+static PsQueue * _pslist_get_queue (PsList * self, Process * process)
+{
+	switch (process_get_state (process))
+	{
+		case WAITING:
+			if (process->is_paused)
+				return NULL;
+			return &self->_ready;
+		case RUNNING:
+			return &self->_running;
+		default:
+			return &self->_done;
+	}
+}
+
+/*
+ * Add a Process at the end of a queue
+ * args:   PsQueue, Process
+ * return: void
+ */
+static void _pslist_queue_append (PsQueue * queue, Process * process)
+{
+	_pslist_queue_insert (queue, process, NULL);
+}
+
+/*
+ * Insert a Process in a queue
+ * args:   PsQueue, Process, Process to insert before (or NULL for the end)
+ * return: void
+ */
+static void _pslist_queue_insert (PsQueue * queue, Process * process,
+								  Process * next)
+{
+	process->_next = next;
+
+	if (next == NULL) {
+		process->_prev = queue->tail;
+		queue->tail = process;
+	} else {
+		process->_prev = next->_prev;
+		next->_prev = process;
+	}
+
+	if (process->_prev == NULL)
+		queue->head = process;
+	else
+		process->_prev->_next = process;
+}
+
+/*
+ * Remove a Process from a queue
+ * args:   PsQueue, Process
+ * return: void
+ */
+static void _pslist_queue_unlink (PsQueue * queue, Process * process)
+{
+	if (process->_prev == NULL)
+		queue->head = process->_next;
+	else
+		process->_prev->_next = process->_next;
+
+	if (process->_next == NULL)
+		queue->tail = process->_prev;
+	else
+		process->_next->_prev = process->_prev;
+
+	process->_prev = NULL;
+	process->_next = NULL;
+}
+
+/*
+ * Insert a Process in the ready queue according to its position in
+ * the list
+ * args:   PsList, Process
+ * return: void
+ */
+static void _pslist_ready_insert (PsList * self, Process * process)
+{
+	Process * p, * q = self->_ready.tail;
+	OsNode * node;
+	int index = pslist_get_ps_index (self, process);
+
+	/* Look both for the next ready Process in the list, and for the
+	 * previous one from the end of the ready queue, and stop as soon as
+	 * either is found */
+	for (node = ostree_next (process->_node); node != NULL;
+		 node = ostree_next (node))
+	{
+		p = node->item;
+		if (_pslist_get_queue (self, p) == &self->_ready) {
+			_pslist_queue_insert (&self->_ready, process, p);
+			return;
+		}
+
+		if (q == NULL || pslist_get_ps_index (self, q) < index) {
+			_pslist_queue_insert (&self->_ready, process,
+								  q == NULL ? self->_ready.head : q->_next);
+			return;
+		}
+		q = q->_prev;
 	}
 
-	/* pid not found */
-	return -1;
+	/* No ready Process follows this one */
+	_pslist_queue_append (&self->_ready, process);
 }
@@ -20,24 +20,58 @@
 #ifndef PSLIST_H
 #define PSLIST_H
 
-#include "list.h"
+#include "ostree.h"
+#include "hashtable.h"
 #include "process.h"
 
-/* PsList is a wrapper around List which provides new methods */
-typedef List PsList;
+typedef struct _PsQueue PsQueue;
 
-/* Wrappers to List's methods */
+/* Doubly linked list of Processes through their _prev/_next links */
+struct _PsQueue
+{
+	Process * head;
+	Process * tail;
+};
+
+typedef struct _PsList PsList;
+
+/* PsList is a wrapper around OsTree which provides new methods, Processes
+ * are also indexed by pid and uid, and queued by state */
+struct _PsList
+{
+	OsTree * _tree;		/* Processes in queue order */
+	HashTable * _pids;	/* running Processes by pid */
+	HashTable * _uids;	/* all Processes by uid */
+	PsQueue _ready;		/* WAITING Processes not paused, in list order */
+	PsQueue _running;	/* RUNNING Processes */
+	PsQueue _done;		/* Processes which have terminated */
+	int _count[STOPPED + 1];	/* number of Processes in each state */
+};
+
+/* Wrappers to OsTree's methods */
 PsList * pslist_new (void);
 void pslist_delete(PsList * self);
+int pslist_len (PsList * self);
 int pslist_append (PsList * self, Process * process);
-int pslist_remove (List * self, Process * process);
+int pslist_remove (PsList * self, Process * process);
 Process * pslist_get_ps (PsList * self, int index);
-int pslist_move_items (List * self, int start, int count, int dest);
+int pslist_move_items (PsList * self, int start, int count, int dest);
+int pslist_move_ps (PsList * self, Process ** ps, int count, int dest);
+
+/* Wrappers to Process' methods which keep the indexes up to date */
+int pslist_run_ps (PsList * self, Process * process);
+int pslist_wait_ps (PsList * self, Process * process, siginfo_t * siginfo);
+int pslist_pause_ps (PsList * self, Process * process);
+int pslist_resume_ps (PsList * self, Process * process);
 
 /* New methods */
 int pslist_get_nps (PsList * self, PsState state, int * list);
+int pslist_count (PsList * self, PsState state);
+Process * pslist_get_first (PsList * self, PsState state);
+Process * pslist_get_next (PsList * self, Process * process);
 Process * pslist_get_ps_by_pid (PsList * self, pid_t pid);
 Process * pslist_get_ps_by_uid (PsList * self, int uid);
 int pslist_get_uid_index (PsList * self, int uid);
+int pslist_get_ps_index (PsList * self, Process * process);
 
 #endif /* PSLIST_H */